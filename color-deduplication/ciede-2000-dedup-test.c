@@ -0,0 +1,216 @@
+// These tests of the deduplication tool written in C99 are released into the public domain.
+// They are provided "as is" without any warranty, express or implied.
+
+// Compilation is done using GCC or CLang :
+// - gcc -std=c99 -Wall -Wextra -pedantic -O3 -pthread -o ciede-2000-dedup-test ciede-2000-dedup-test.c -lm
+// - clang -std=c99 -Wall -Wextra -pedantic -O3 -pthread -o ciede-2000-dedup-test ciede-2000-dedup-test.c -lm
+
+// Small chunks, so that the threads share the colors and their unions race.
+#define DEDUP_CHUNK 64
+#define CIEDE_2000_DEDUP_NO_MAIN
+#include "ciede-2000-dedup.c"
+
+#include <stdio.h>
+
+typedef unsigned long long int u64;
+
+static u64 xor_random(u64 *s) {
+	// A shift-register generator has a reproducible behavior across platforms.
+	return *s ^= *s << 13, *s ^= *s >> 7, *s ^= *s << 17;
+}
+
+static double rand_double_64(double min, double max, u64 *seed) {
+	// Normalize to the range [0, 1) and scale to [min, max)
+	return min + (max - min) * ((double) xor_random(seed) / 18446744073709551616.0);
+}
+
+enum dataset { UNIFORM, HIGH_CHROMA, BLUE_REGION, OUTLIERS };
+
+static const char *dataset_names[] = {"uniform", "high chroma", "blue region", "outliers"};
+
+// Fills the colors in clusters, whose spread is comparable to the threshold, so that
+// many pairs are close to it. The blue region is where the hue rotation term matters.
+static void generate(enum dataset kind, double threshold, size_t n, double *lab, u64 *seed) {
+	for (size_t i = 0; i < n;) {
+		double l = rand_double_64(0.0, 100.0, seed), a, b;
+		if (kind == HIGH_CHROMA || kind == BLUE_REGION) {
+			const double c = rand_double_64(60.0, 130.0, seed);
+			const double h = kind == BLUE_REGION ? rand_double_64(250.0, 300.0, seed) * M_PI / 180.0 : rand_double_64(0.0, 2.0 * M_PI, seed);
+			a = c * cos(h);
+			b = c * sin(h);
+		} else {
+			a = rand_double_64(-128.0, 128.0, seed);
+			b = rand_double_64(-128.0, 128.0, seed);
+		}
+		const double spread = threshold * rand_double_64(0.1, 8.0, seed);
+		for (u64 k = 1 + xor_random(seed) % 6; k && i < n; --k, ++i) {
+			lab[3 * i] = l + rand_double_64(-0.5, 0.5, seed) * spread;
+			lab[3 * i + 1] = a + rand_double_64(-1.0, 1.0, seed) * spread;
+			lab[3 * i + 2] = b + rand_double_64(-1.0, 1.0, seed) * spread;
+		}
+	}
+	if (kind == OUTLIERS && 4 <= n) {
+		// Distant colors, in the wrong units or mistyped, must not hide any pair.
+		lab[0] = 50.0, lab[1] = 1E6, lab[2] = 0.0;
+		lab[3] = 50.0, lab[4] = 1E6 + 0.01, lab[5] = 0.0;
+		lab[6] = -300.0, lab[7] = -5E4, lab[8] = 3E5;
+		lab[9] = 255.0, lab[10] = 255.0, lab[11] = 255.0;
+	}
+}
+
+static uint32_t brute_find(uint32_t *parent, uint32_t x) {
+	while (parent[x] != x)
+		x = parent[x];
+	return x;
+}
+
+// The exhaustive comparison, whose groups are also labeled by their first color.
+static size_t brute_force(const double *lab, size_t n, double threshold, uint32_t *group) {
+	size_t n_pairs = 0;
+	for (size_t i = 0; i < n; ++i)
+		group[i] = (uint32_t) i;
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = i + 1; j < n; ++j)
+			if (ciede_2000(lab[3 * i], lab[3 * i + 1], lab[3 * i + 2], lab[3 * j], lab[3 * j + 1], lab[3 * j + 2]) < threshold) {
+				++n_pairs;
+				const uint32_t x = brute_find(group, (uint32_t) i), y = brute_find(group, (uint32_t) j);
+				if (x < y)
+					group[y] = x;
+				else if (y < x)
+					group[x] = y;
+			}
+	for (size_t i = 0; i < n; ++i)
+		group[i] = group[group[i]];
+	return n_pairs;
+}
+
+static int test_brute_force(u64 *seed, size_t n) {
+	const double thresholds[] = {0.3, 2.0, 10.0};
+	const int threads[] = {1, 4};
+	double *lab = malloc(3 * n * sizeof(*lab));
+	uint32_t *expected = malloc(n * sizeof(*expected)), *group = malloc(n * sizeof(*group));
+	int n_failures = 0;
+	for (int kind = UNIFORM; kind <= OUTLIERS; ++kind)
+		for (int i = 0; i < 3; ++i) {
+			generate((enum dataset) kind, thresholds[i], n, lab, seed);
+			const size_t n_pairs = brute_force(lab, n, thresholds[i], expected);
+			for (int j = 0; j < 2; ++j) {
+				struct ciede_2000_dedup_stats stats = {0};
+				size_t n_wrong = 0;
+				if (ciede_2000_dedup(lab, n, thresholds[i], threads[j], group, &stats)) {
+					n_wrong = n;
+				} else
+					for (size_t k = 0; k < n; ++k)
+						n_wrong += group[k] != expected[k];
+				if (n_wrong || stats.n_pairs != n_pairs) {
+					printf("ciede_2000_dedup %s, threshold %g, %d threads : %zu wrong groups, %zu pairs instead of %zu\n",
+						   dataset_names[kind], thresholds[i], threads[j], n_wrong, stats.n_pairs, n_pairs);
+					++n_failures;
+				}
+			}
+		}
+	if (!n_failures)
+		printf("ciede_2000_dedup <=> brute force : PASS\n");
+	free(lab);
+	free(expected);
+	free(group);
+	return n_failures;
+}
+
+static int test_degenerate_grids(u64 *seed, size_t n) {
+	double *lab = malloc(3 * (n + 3) * sizeof(*lab));
+	uint32_t *expected = malloc((n + 3) * sizeof(*expected)), *group = malloc((n + 3) * sizeof(*group));
+	struct ciede_2000_dedup_stats base = {0}, stats = {0};
+	int n_failures = 0;
+	// Far colors must neither pass the geometric filter nor coarsen the grid.
+	generate(UNIFORM, 0.3, n, lab, seed);
+	ciede_2000_dedup(lab, n, 0.3, 4, group, &base);
+	lab[3 * n] = 1E5, lab[3 * n + 1] = 0.0, lab[3 * n + 2] = 0.0;
+	lab[3 * n + 3] = -1E5, lab[3 * n + 4] = 10.0, lab[3 * n + 5] = 10.0;
+	lab[3 * n + 6] = 50.0, lab[3 * n + 7] = 1E6, lab[3 * n + 8] = 0.0;
+	if (ciede_2000_dedup(lab, n + 3, 0.3, 4, group, &stats) || stats.n_evaluations != base.n_evaluations) {
+		printf("ciede_2000_dedup outliers : %zu evaluations instead of %zu\n", stats.n_evaluations, base.n_evaluations);
+		++n_failures;
+	}
+	// Exact duplicates under a tiny threshold, whose reach is far smaller than the range of the colors.
+	for (size_t i = 0; i < n; i += 4)
+		memcpy(lab + 3 * (i + 1), lab + 3 * i, 3 * sizeof(*lab));
+	const size_t n_pairs = brute_force(lab, n, 1E-9, expected);
+	size_t n_wrong = 0;
+	if (ciede_2000_dedup(lab, n, 1E-9, 4, group, &stats))
+		n_wrong = n;
+	else
+		for (size_t k = 0; k < n; ++k)
+			n_wrong += group[k] != expected[k];
+	if (n_wrong || stats.n_pairs != n_pairs || stats.n_buckets < n / 2) {
+		printf("ciede_2000_dedup threshold 1e-9 : %zu wrong groups, %zu pairs instead of %zu, %zu buckets\n", n_wrong, stats.n_pairs, n_pairs, stats.n_buckets);
+		++n_failures;
+	}
+	if (!n_failures)
+		printf("ciede_2000_dedup outliers and tiny threshold : PASS\n");
+	free(lab);
+	free(expected);
+	free(group);
+	return n_failures;
+}
+
+static int test_invalid_arguments(void) {
+	double lab[6] = {50.0, 10.0, 10.0, 50.0, 10.0, 10.1};
+	uint32_t group[2];
+	const double thresholds[] = {0.0, -1.0, DEDUP_MAX_THRESHOLD + 0.5, NAN};
+	int n_failures = 0;
+	for (int i = 0; i < 4; ++i) {
+		errno = 0;
+		if (ciede_2000_dedup(lab, 2, thresholds[i], 1, group, NULL) != -1 || errno != EINVAL) {
+			printf("ciede_2000_dedup threshold %g : EINVAL expected\n", thresholds[i]);
+			++n_failures;
+		}
+	}
+	// The largest threshold, which depends on the parametric factors, is accepted.
+	if (ciede_2000_dedup(lab, 2, DEDUP_MAX_THRESHOLD, 1, group, NULL) || group[1] != 0) {
+		printf("ciede_2000_dedup threshold %g : success expected\n", DEDUP_MAX_THRESHOLD);
+		++n_failures;
+	}
+	for (int i = 0; i < 6; ++i) {
+		const double saved = lab[i];
+		lab[i] = i & 1 ? NAN : INFINITY;
+		errno = 0;
+		if (ciede_2000_dedup(lab, 2, 0.3, 1, group, NULL) != -1 || errno != EINVAL) {
+			printf("ciede_2000_dedup non-finite component %d : EINVAL expected\n", i);
+			++n_failures;
+		}
+		lab[i] = saved;
+	}
+	if (!n_failures)
+		printf("ciede_2000_dedup invalid arguments : PASS\n");
+	return n_failures;
+}
+
+static int test_parametric_factors(void) {
+	// A pure lightness difference and a pure chroma difference isolate k_l and k_c.
+	double n = (50.5 - 50.0) * (50.5 - 50.0);
+	const double k_l = 1.0 / (ciede_2000(50.0, 0.0, 0.0, 51.0, 0.0, 0.0) * (1.0 + 0.015 * n / sqrt(20.0 + n)));
+	const double k_c = 1.0 / (ciede_2000(50.0, 0.0, 10.0, 50.0, 0.0, 11.0) * (1.0 + 0.045 * 10.5));
+	// Two colors symmetric about the b* axis have the same chroma and a mean hue of 90°, isolating k_h.
+	n = pow(hypot(1.0, 10.0), 7.0);
+	n = 1.0 + 0.5 * (1.0 - sqrt(n / (n + 6103515625.0)));
+	const double c = hypot(n, 10.0), h_d = atan2(10.0, -n) - M_PI * 0.5, h_m = M_PI * 0.5;
+	const double t = 1.0 + 0.24 * sin(2.0 * h_m + M_PI * 0.5) + 0.32 * sin(3.0 * h_m + 8.0 * M_PI / 15.0)
+				- 0.17 * sin(h_m + M_PI / 3.0) - 0.20 * sin(4.0 * h_m + 3.0 * M_PI / 20.0);
+	const double k_h = 2.0 * c * sin(h_d) / (ciede_2000(50.0, 1.0, 10.0, 50.0, -1.0, 10.0) * (1.0 + 0.015 * c * t));
+	if (1E-9 < fabs(k_l - DEDUP_K_L) || 1E-9 < fabs(k_c - DEDUP_K_C) || 1E-9 < fabs(k_h - DEDUP_K_H)) {
+		printf("ciede_2000 uses k_l=%g k_c=%g k_h=%g while DEDUP_K_L=%g DEDUP_K_C=%g DEDUP_K_H=%g\n", k_l, k_c, k_h, (double) DEDUP_K_L, (double) DEDUP_K_C, (double) DEDUP_K_H);
+		return 1;
+	}
+	printf("ciede_2000 <=> DEDUP_K_L, DEDUP_K_C, DEDUP_K_H : PASS\n");
+	return 0;
+}
+
+int main(void) {
+	u64 seed = 0x2236b69a7d223bd;
+	int n_failures = test_parametric_factors();
+	n_failures += test_invalid_arguments();
+	n_failures += test_degenerate_grids(&seed, 5000);
+	n_failures += test_brute_force(&seed, 2000);
+	return n_failures != 0;
+}
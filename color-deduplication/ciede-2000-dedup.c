@@ -0,0 +1,590 @@
+// This deduplication tool written in C99 is not affiliated with the CIE (International Commission on Illumination),
+// and is released into the public domain. It is provided "as is" without any warranty, express or implied.
+
+// It groups the colors of a library whose ΔE2000 is below a threshold. Instead of comparing all the pairs,
+// the colors are bucketed on a L*a*b* grid sized from the threshold, only neighboring buckets are compared
+// with the exact ciede_2000 function, and the matching pairs are merged in a concurrent union-find.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The classic CIE ΔE implementation, ΔE2000 (ΔE00), shared with the other C sources.
+#include "../ciede-2000.c"
+
+// Number of colors taken at once by a thread, small enough to balance the workload.
+#ifndef DEDUP_CHUNK
+#define DEDUP_CHUNK 4096
+#endif
+
+// The grid is sparse, each axis has up to 2^21 cells.
+#define DEDUP_AXIS_BITS 21
+#define DEDUP_AXIS_CELLS ((size_t) 1 << DEDUP_AXIS_BITS)
+
+// The parametric factors k_l, k_c and k_h of ciede_2000, on which the neighborhood depends.
+// They must be kept equal to the ones of ciede-2000.c when those are adjusted, for example
+// when the textile industry sets k_l to 2.0, otherwise pairs below the threshold are missed.
+#ifndef DEDUP_K_L
+#define DEDUP_K_L 1.0
+#endif
+#ifndef DEDUP_K_C
+#define DEDUP_K_C 1.0
+#endif
+#ifndef DEDUP_K_H
+#define DEDUP_K_H 1.0
+#endif
+
+// A bound on the ΔE2000 is available as long as the threshold multiplied by max(k_c, k_h) remains
+// well below 10.84, and by k_l below 133, so the maximum of 10 shrinks as the factors grow above 1.
+#define DEDUP_MAX_THRESHOLD (10.0 / fmax(1.0, fmax(DEDUP_K_L, fmax(DEDUP_K_C, DEDUP_K_H))))
+
+struct ciede_2000_dedup_stats {
+	size_t n_colors;        // Colors examined.
+	size_t n_groups;        // Groups found, single colors included.
+	size_t n_pairs;         // Pairs of colors whose ΔE2000 is below the threshold.
+	size_t n_evaluations;   // Calls to ciede_2000, once the geometric filter is passed.
+	size_t n_buckets;       // Occupied cells of the L*a*b* grid.
+	int n_threads;          // Threads that took part in the search.
+	double index_seconds;   // Time spent bucketing the colors.
+	double search_seconds;  // Time spent comparing the neighboring buckets.
+	double group_seconds;   // Time spent labeling the groups.
+};
+
+struct dedup_color {
+	double l, a, b, c;
+	uint32_t index;
+};
+
+struct dedup_context {
+	const struct dedup_color *colors;
+	const uint64_t *keys;
+	uint32_t *parent;
+	size_t n, next;
+	double threshold, l_min, a_min, b_min, l_step, ab_step, l_reach, l_bound, ab_reach, ab_bound;
+};
+
+struct dedup_worker {
+	struct dedup_context *ctx;
+	pthread_t thread;
+	size_t n_pairs, n_evaluations;
+};
+
+static double dedup_seconds(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double) t.tv_sec + (double) t.tv_nsec * 1E-9;
+}
+
+static uint64_t dedup_cell(const double v, const double min, const double step) {
+	const double k = floor((v - min) / step);
+	return k < 0.0 ? 0 : (double) DEDUP_AXIS_CELLS <= k ? DEDUP_AXIS_CELLS - 1 : (uint64_t) k;
+}
+
+static size_t dedup_lower_bound(const uint64_t *keys, size_t lo, const size_t n, const uint64_t key) {
+	// Galloping search, the cells being visited in increasing order from a cursor.
+	size_t hi = lo, step = 1;
+	while (hi < n && keys[hi] < key) {
+		lo = hi + 1;
+		hi += step;
+		step <<= 1;
+	}
+	if (n < hi)
+		hi = n;
+	while (lo < hi) {
+		const size_t m = lo + (hi - lo) / 2;
+		if (keys[m] < key)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+static uint32_t dedup_find(uint32_t *parent, uint32_t x) {
+	// Path halving. Parents only ever move up to an ancestor, so relaxed atomics are sufficient
+	// for concurrent finds, a stale read being caught by the compare-and-swap of the union.
+	for (;;) {
+		uint32_t p = __atomic_load_n(parent + x, __ATOMIC_RELAXED);
+		if (p == x)
+			return x;
+		const uint32_t g = __atomic_load_n(parent + p, __ATOMIC_RELAXED);
+		if (g == p)
+			return p;
+		__atomic_compare_exchange_n(parent + x, &p, g, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+		x = g;
+	}
+}
+
+static void dedup_union(uint32_t *parent, uint32_t x, uint32_t y) {
+	for (;;) {
+		x = dedup_find(parent, x);
+		y = dedup_find(parent, y);
+		if (x == y)
+			return;
+		// The larger root is linked under the smaller one, so that a group is
+		// always represented by the first of its colors in the input order.
+		if (x < y) {
+			const uint32_t t = x;
+			x = y;
+			y = t;
+		}
+		uint32_t expected = x;
+		if (__atomic_compare_exchange_n(parent + x, &expected, y, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return;
+	}
+}
+
+static void *dedup_search(void *arg) {
+	struct dedup_worker *w = arg;
+	struct dedup_context *ctx = w->ctx;
+	const struct dedup_color *colors = ctx->colors;
+	const uint64_t *keys = ctx->keys;
+	size_t n_pairs = 0, n_evaluations = 0;
+	for (;;) {
+		const size_t begin = __atomic_fetch_add(&ctx->next, DEDUP_CHUNK, __ATOMIC_RELAXED);
+		if (ctx->n <= begin)
+			break;
+		const size_t end = ctx->n - begin < DEDUP_CHUNK ? ctx->n : begin + DEDUP_CHUNK;
+		for (size_t p = begin, p_end; p < end; p = p_end) {
+			// The colors of a cell share the lookup of their neighboring rows.
+			double l_min = INFINITY, l_max = -INFINITY, a_min = INFINITY, a_max = -INFINITY, b_min = INFINITY, b_max = -INFINITY;
+			for (p_end = p; p_end < end && keys[p_end] == keys[p]; ++p_end) {
+				const struct dedup_color *x = colors + p_end;
+				// Every color closer than the threshold to x lies within these reaches, which grow
+				// with the distance of L* to 50 and with the chroma, as the ΔE2000 becomes less sensitive.
+				const double r_l = ctx->l_reach * (1.0 + 0.015 * fabs(x->l - 50.0));
+				const double r = ctx->ab_reach * (1.0 + 0.0675 * x->c);
+				l_min = fmin(l_min, x->l - r_l);
+				l_max = fmax(l_max, x->l + r_l);
+				a_min = fmin(a_min, x->a - r);
+				a_max = fmax(a_max, x->a + r);
+				b_min = fmin(b_min, x->b - r);
+				b_max = fmax(b_max, x->b + r);
+			}
+			const uint64_t l_lo = dedup_cell(l_min, ctx->l_min, ctx->l_step);
+			const uint64_t l_hi = dedup_cell(l_max, ctx->l_min, ctx->l_step);
+			const uint64_t a_lo = dedup_cell(a_min, ctx->a_min, ctx->ab_step);
+			const uint64_t a_hi = dedup_cell(a_max, ctx->a_min, ctx->ab_step);
+			const uint64_t b_lo = dedup_cell(b_min, ctx->b_min, ctx->ab_step);
+			const uint64_t b_hi = dedup_cell(b_max, ctx->b_min, ctx->ab_step);
+			// Each pair is examined once, from the color that comes first. The rows of
+			// neighboring cells are visited in the sorted order, from the next color.
+			size_t cursor = p + 1;
+			for (uint64_t i_l = l_lo; i_l <= l_hi; ++i_l)
+				for (uint64_t i_a = a_lo; i_a <= a_hi && cursor < ctx->n; ++i_a) {
+					const uint64_t row = i_l << DEDUP_AXIS_BITS | i_a;
+					const uint64_t key_lo = row << DEDUP_AXIS_BITS | b_lo, key_hi = row << DEDUP_AXIS_BITS | b_hi;
+					const size_t q_begin = dedup_lower_bound(keys, cursor, ctx->n, key_lo);
+					for (size_t i = p; i < p_end; ++i) {
+						const struct dedup_color *x = colors + i;
+						for (size_t q = q_begin <= i ? i + 1 : q_begin; q < ctx->n && keys[q] <= key_hi; ++q) {
+							const struct dedup_color *y = colors + q;
+							const double s_l = ctx->l_bound * (1.0 + 0.015 * fabs(0.5 * (x->l + y->l) - 50.0));
+							if (s_l < fabs(y->l - x->l))
+								continue;
+							const double d_a = y->a - x->a, d_b = y->b - x->b;
+							const double s = ctx->ab_bound * (1.0 + 0.03375 * (x->c + y->c));
+							if (s * s < d_a * d_a + d_b * d_b)
+								continue;
+							++n_evaluations;
+							if (ciede_2000(x->l, x->a, x->b, y->l, y->a, y->b) < ctx->threshold) {
+								++n_pairs;
+								dedup_union(ctx->parent, x->index, y->index);
+							}
+						}
+					}
+					cursor = q_begin;
+				}
+		}
+	}
+	w->n_pairs = n_pairs;
+	w->n_evaluations = n_evaluations;
+	return NULL;
+}
+
+// Groups the n colors of lab, stored as (L*, a*, b*) triplets, so that two colors whose ΔE2000 is below
+// the threshold are in the same group, transitively. On return, group[i] holds the index of the first
+// color of the group of color i. Returns 0 on success, or -1 with errno set to EINVAL, EOVERFLOW or ENOMEM.
+static int ciede_2000_dedup(const double *lab, const size_t n, const double threshold, int n_threads, uint32_t *group, struct ciede_2000_dedup_stats *stats) {
+	if (!(0.0 < threshold && threshold <= DEDUP_MAX_THRESHOLD) || (n && (!lab || !group))) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (UINT32_MAX - 1 < n) {
+		errno = EOVERFLOW;
+		return -1;
+	}
+	if (n_threads < 1)
+		n_threads = 1;
+	const double t_0 = dedup_seconds();
+	double l_min = 0.0, l_max = 0.0, a_min = 0.0, a_max = 0.0, b_min = 0.0, b_max = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		const double l = lab[3 * i], a = lab[3 * i + 1], b = lab[3 * i + 2];
+		if (!isfinite(l) || !isfinite(a) || !isfinite(b)) {
+			errno = EINVAL;
+			return -1;
+		}
+		if (i == 0 || l < l_min) l_min = l;
+		if (i == 0 || l_max < l) l_max = l;
+		if (i == 0 || a < a_min) a_min = a;
+		if (i == 0 || a_max < a) a_max = a;
+		if (i == 0 || b < b_min) b_min = b;
+		if (i == 0 || b_max < b) b_max = b;
+	}
+	if (!isfinite(l_max - l_min) || !isfinite(a_max - a_min) || !isfinite(b_max - b_min)) {
+		errno = EINVAL;
+		return -1;
+	}
+	// Bounds on the components of the ΔE2000 of a pair below the threshold, widened by a small
+	// margin against rounding. The lightness term ΔL / (k_l S_L) alone bounds ΔL, and S_L <= 1 +
+	// 0.015 |L_m - 50| for the mean lightness L_m of the pair, so that ΔL < t k_l (1 + 0.015 |L_m - 50|),
+	// and the reach of a color follows from |L_m - 50| <= |L_1 - 50| + ΔL / 2. The hue rotation |R_T| < √3 leaves at least (1 - √3 / 2) of the sum
+	// of the squared chroma and hue terms, divided by at most k S_C with k = max(k_c, k_h), the mean
+	// chroma in a' of S_C being up to 1.5 times the one in a. Since Δa <= Δa', the Euclidean distance
+	// in the a*b* plane satisfies d < t k (1 + √3) (1 + 0.03375 (C_1 + C_2)), and the reach of a color
+	// follows from C_2 <= C_1 + d.
+	const double margin = 1.0 + 1E-6;
+	const double l_bound = threshold * DEDUP_K_L * margin;
+	const double ab_bound = threshold * fmax(DEDUP_K_C, DEDUP_K_H) * (1.0 + sqrt(3.0)) * margin;
+	const double l_reach = l_bound / (1.0 - 0.0075 * l_bound);
+	const double ab_reach = ab_bound / (1.0 - 0.03375 * ab_bound);
+	// The grid steps follow the reach of a neutral color, at the ends of the usual L* range of 0 to
+	// 100, and twice as wide in the a*b* plane where the reach grows with chroma. For tiny thresholds,
+	// the steps are widened so that the range of the colors fits in the cells of each axis. Only the occupied cells are stored, sorted by their coordinates,
+	// so that distant colors do not coarsen the grid of the rest of the library.
+	struct dedup_context ctx = {0};
+	ctx.n = n;
+	ctx.threshold = threshold;
+	ctx.l_min = l_min;
+	ctx.a_min = a_min;
+	ctx.b_min = b_min;
+	ctx.l_step = fmax(l_reach * (1.0 + 0.015 * 50.0), (l_max - l_min) / (double) (DEDUP_AXIS_CELLS - 1));
+	ctx.ab_step = fmax(2.0 * ab_reach, fmax(a_max - a_min, b_max - b_min) / (double) (DEDUP_AXIS_CELLS - 1));
+	ctx.l_reach = l_reach;
+	ctx.l_bound = l_bound;
+	ctx.ab_reach = ab_reach;
+	ctx.ab_bound = ab_bound;
+	const size_t size = n ? n : 1;
+	struct dedup_color *colors = malloc(size * sizeof(*colors));
+	uint64_t *keys = malloc(size * sizeof(*keys)), *keys_tmp = malloc(size * sizeof(*keys_tmp));
+	uint32_t *order = malloc(size * sizeof(*order)), *order_tmp = malloc(size * sizeof(*order_tmp));
+	size_t *histogram = malloc(((size_t) 1 << 16) * sizeof(*histogram));
+	struct dedup_worker *workers = calloc((size_t) n_threads, sizeof(*workers));
+	if (!colors || !keys || !keys_tmp || !order || !order_tmp || !histogram || !workers)
+		goto out_of_memory;
+	for (size_t i = 0; i < n; ++i) {
+		const double *x = lab + 3 * i;
+		keys[i] = (dedup_cell(x[0], l_min, ctx.l_step) << DEDUP_AXIS_BITS | dedup_cell(x[1], a_min, ctx.ab_step)) << DEDUP_AXIS_BITS | dedup_cell(x[2], b_min, ctx.ab_step);
+		order[i] = (uint32_t) i;
+	}
+	// Stable radix sort of the colors by cell, the input order being kept inside a cell.
+	for (int shift = 0; shift < 3 * DEDUP_AXIS_BITS; shift += 16) {
+		memset(histogram, 0, ((size_t) 1 << 16) * sizeof(*histogram));
+		for (size_t i = 0; i < n; ++i)
+			++histogram[keys[i] >> shift & 0xFFFF];
+		if (n && histogram[keys[0] >> shift & 0xFFFF] == n)
+			continue;
+		for (size_t i = 0, sum = 0; i < (size_t) 1 << 16; ++i) {
+			const size_t count = histogram[i];
+			histogram[i] = sum;
+			sum += count;
+		}
+		for (size_t i = 0; i < n; ++i) {
+			const size_t j = histogram[keys[i] >> shift & 0xFFFF]++;
+			keys_tmp[j] = keys[i];
+			order_tmp[j] = order[i];
+		}
+		uint64_t *k = keys;
+		keys = keys_tmp;
+		keys_tmp = k;
+		uint32_t *o = order;
+		order = order_tmp;
+		order_tmp = o;
+	}
+	free(keys_tmp);
+	free(order_tmp);
+	free(histogram);
+	keys_tmp = NULL;
+	order_tmp = NULL;
+	histogram = NULL;
+	size_t n_buckets = 0;
+	for (size_t i = 0; i < n; ++i) {
+		const double *x = lab + 3 * order[i];
+		struct dedup_color *y = colors + i;
+		y->l = x[0];
+		y->a = x[1];
+		y->b = x[2];
+		y->c = hypot(x[1], x[2]);
+		y->index = order[i];
+		n_buckets += i == 0 || keys[i] != keys[i - 1];
+	}
+	free(order);
+	order = NULL;
+	for (size_t i = 0; i < n; ++i)
+		group[i] = (uint32_t) i;
+	ctx.colors = colors;
+	ctx.keys = keys;
+	ctx.parent = group;
+	const double t_1 = dedup_seconds();
+	// The calling thread takes part in the search, the other threads are optional.
+	int n_started = 1;
+	for (int i = 0; i < n_threads; ++i)
+		workers[i].ctx = &ctx;
+	for (int i = 1; i < n_threads; ++i)
+		if (pthread_create(&workers[i].thread, NULL, dedup_search, workers + i) == 0)
+			++n_started;
+		else
+			break;
+	dedup_search(workers);
+	for (int i = 1; i < n_started; ++i)
+		pthread_join(workers[i].thread, NULL);
+	const double t_2 = dedup_seconds();
+	size_t n_groups = 0, n_pairs = 0, n_evaluations = 0;
+	for (int i = 0; i < n_started; ++i) {
+		n_pairs += workers[i].n_pairs;
+		n_evaluations += workers[i].n_evaluations;
+	}
+	// A root precedes its descendants, so a single pass labels every color.
+	for (size_t i = 0; i < n; ++i)
+		if (group[i] == i)
+			++n_groups;
+		else
+			group[i] = group[group[i]];
+	const double t_3 = dedup_seconds();
+	free(colors);
+	free(keys);
+	free(workers);
+	if (stats) {
+		stats->n_colors = n;
+		stats->n_groups = n_groups;
+		stats->n_pairs = n_pairs;
+		stats->n_evaluations = n_evaluations;
+		stats->n_buckets = n_buckets;
+		stats->n_threads = n_started;
+		stats->index_seconds = t_1 - t_0;
+		stats->search_seconds = t_2 - t_1;
+		stats->group_seconds = t_3 - t_2;
+	}
+	return 0;
+out_of_memory:
+	free(colors);
+	free(keys);
+	free(keys_tmp);
+	free(order);
+	free(order_tmp);
+	free(histogram);
+	free(workers);
+	errno = ENOMEM;
+	return -1;
+}
+
+#ifndef CIEDE_2000_DEDUP_NO_MAIN
+
+// Compilation is done using GCC or CLang :
+// - gcc -std=c99 -Wall -Wextra -pedantic -O3 -pthread -o ciede-2000-dedup ciede-2000-dedup.c -lm
+// - clang -std=c99 -Wall -Wextra -pedantic -O3 -pthread -o ciede-2000-dedup ciede-2000-dedup.c -lm
+
+// Usage : ./ciede-2000-dedup [-t threshold] [-j threads] [-b] file
+// - The file is memory-mapped, it contains one "L*,a*,b*" color per line, other lines are ignored.
+// - With -b, the file is raw, made of (L*, a*, b*) triplets of native doubles.
+// - Each group of at least two colors is printed on a line, as the zero-based indexes of its colors.
+// - The summary and the timing are printed on the standard error.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int dedup_is_number_start(const char c) {
+	return ('0' <= c && c <= '9') || c == '-' || c == '+' || c == '.';
+}
+
+// Reads the colors of a text file, "L*,a*,b*" per line, commas, semicolons and blanks being
+// separators. Lines that do not start with a number, such as headers, are skipped.
+static double *dedup_parse_text(const char *s, const char *end, size_t *n) {
+	size_t size = 0, capacity = 1 << 16, line = 0;
+	double *lab = malloc(capacity * sizeof(*lab));
+	while (lab && s < end) {
+		++line;
+		const char *eol = memchr(s, '\n', (size_t) (end - s));
+		if (!eol)
+			eol = end;
+		while (s < eol && (*s == ' ' || *s == '\t'))
+			++s;
+		if (s < eol && dedup_is_number_start(*s)) {
+			if (capacity < size + 3) {
+				double *grown = realloc(lab, 2 * capacity * sizeof(*lab));
+				if (!grown) {
+					free(lab);
+					return NULL;
+				}
+				lab = grown;
+				capacity *= 2;
+			}
+			for (int j = 0; j < 3; ++j) {
+				// The number is copied, so that strtod never reads past the mapped file.
+				char buf[64];
+				size_t len = 0;
+				while (s < eol && (*s == ' ' || *s == '\t' || *s == ',' || *s == ';' || *s == '\r'))
+					++s;
+				while (s < eol && len < sizeof(buf) && (dedup_is_number_start(*s) || *s == 'e' || *s == 'E'))
+					buf[len++] = *s++;
+				// A number longer than the buffer is an error, rather than being split in two.
+				const int truncated = len == sizeof(buf);
+				buf[truncated ? 0 : len] = 0;
+				char *stop;
+				lab[size + j] = strtod(buf, &stop);
+				if (!len || truncated || *stop)
+					goto invalid;
+			}
+			// A line holds one color, so only separators may follow the third number.
+			while (s < eol && (*s == ' ' || *s == '\t' || *s == ',' || *s == ';' || *s == '\r'))
+				++s;
+			if (s < eol)
+				goto invalid;
+			size += 3;
+		}
+		s = eol < end ? eol + 1 : end;
+	}
+	*n = size / 3;
+	return lab;
+invalid:
+	fprintf(stderr, "line %zu : expected three numbers\n", line);
+	free(lab);
+	errno = EINVAL;
+	return NULL;
+}
+
+int main(int argc, char *argv[]) {
+	double threshold = 0.3;
+	long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	int binary = 0;
+	const char *path = NULL;
+	int usage = 0;
+	char *stop;
+	for (int i = 1; i < argc; ++i)
+		if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+			threshold = strtod(argv[++i], &stop);
+			usage |= !*argv[i] || *stop || !(0.0 < threshold && threshold <= DEDUP_MAX_THRESHOLD);
+		} else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+			n_threads = strtol(argv[++i], &stop, 10);
+			usage |= !*argv[i] || *stop || n_threads < 1;
+		} else if (!strcmp(argv[i], "-b"))
+			binary = 1;
+		else if (!path && *argv[i] != '-')
+			path = argv[i];
+		else
+			usage = 1;
+	if (usage || !path) {
+		fprintf(stderr, "Usage : %s [-t threshold] [-j threads] [-b] file\n", argv[0]);
+		return 2;
+	}
+	if (n_threads < 1)
+		n_threads = 1;
+	else if (1024 < n_threads)
+		n_threads = 1024;
+	const double t_0 = dedup_seconds();
+	const int fd = open(path, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st)) {
+		perror(path);
+		return 1;
+	}
+	const size_t length = (size_t) st.st_size;
+	void *map = length ? mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+	close(fd);
+	if (map == MAP_FAILED) {
+		perror(path);
+		return 1;
+	}
+	if (map)
+		posix_madvise(map, length, POSIX_MADV_SEQUENTIAL);
+	size_t n = 0;
+	double *parsed = NULL;
+	const double *lab;
+	if (binary) {
+		if (length % (3 * sizeof(double))) {
+			fprintf(stderr, "%s : the size is not a multiple of %zu bytes\n", path, 3 * sizeof(double));
+			return 1;
+		}
+		n = length / (3 * sizeof(double));
+		lab = map;
+		// The pages are touched now, so that reading the file is counted in the load time.
+		const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+		volatile unsigned char sink = 0;
+		for (size_t i = 0; i < length; i += page)
+			sink ^= ((const unsigned char *) map)[i];
+	} else {
+		lab = parsed = map ? dedup_parse_text(map, (const char *) map + length, &n) : calloc(1, sizeof(double));
+		if (!parsed) {
+			perror(path);
+			return 1;
+		}
+	}
+	uint32_t *group = malloc((n ? n : 1) * sizeof(*group));
+	struct ciede_2000_dedup_stats stats;
+	const double t_1 = dedup_seconds();
+	if (!group || ciede_2000_dedup(lab, n, threshold, (int) n_threads, group, &stats)) {
+		perror("ciede_2000_dedup");
+		return 1;
+	}
+	if (parsed)
+		free(parsed);
+	if (map)
+		munmap(map, length);
+	// Members are listed by group, in the input order, through a counting sort on the first color.
+	const double t_2 = dedup_seconds();
+	uint32_t *start = calloc(n + 1, sizeof(*start)), *members = malloc((n ? n : 1) * sizeof(*members));
+	if (!start || !members) {
+		perror("output");
+		return 1;
+	}
+	for (size_t i = 0; i < n; ++i)
+		++start[group[i] + 1];
+	size_t n_shared = 0, largest = n ? 1 : 0;
+	for (size_t i = 0; i < n; ++i) {
+		const size_t size = start[i + 1];
+		if (1 < size) {
+			++n_shared;
+			if (largest < size)
+				largest = size;
+		}
+		start[i + 1] += start[i];
+	}
+	for (size_t i = 0; i < n; ++i)
+		members[start[group[i]]++] = (uint32_t) i;
+	for (size_t i = 0, begin = 0; i < n; begin = start[i++])
+		if (1 < start[i] - begin) {
+			for (size_t j = begin; j < start[i]; ++j)
+				printf(j == begin ? "%u" : " %u", (unsigned) members[j]);
+			putchar('\n');
+		}
+	fflush(stdout);
+	const double t_3 = dedup_seconds();
+	fprintf(stderr, "colors      : %zu\n", stats.n_colors);
+	fprintf(stderr, "threshold   : ΔE00 < %g\n", threshold);
+	fprintf(stderr, "threads     : %d\n", stats.n_threads);
+	fprintf(stderr, "buckets     : %zu\n", stats.n_buckets);
+	fprintf(stderr, "evaluations : %zu\n", stats.n_evaluations);
+	fprintf(stderr, "pairs       : %zu\n", stats.n_pairs);
+	fprintf(stderr, "groups      : %zu, including %zu with duplicates, the largest having %zu colors\n", stats.n_groups, n_shared, largest);
+	fprintf(stderr, "duplicates  : %zu\n", stats.n_colors - stats.n_groups);
+	fprintf(stderr, "load        : %.3f s\n", t_1 - t_0);
+	fprintf(stderr, "index       : %.3f s\n", stats.index_seconds);
+	fprintf(stderr, "search      : %.3f s\n", stats.search_seconds);
+	fprintf(stderr, "group       : %.3f s\n", stats.group_seconds);
+	fprintf(stderr, "output      : %.3f s\n", t_3 - t_2);
+	free(start);
+	free(members);
+	free(group);
+	return 0;
+}
+
+#endif